@@ -1,30 +1,25 @@
 #include "poker.h"
 
-Card deck[NUM_CARDS];
+CardIndex deck[NUM_CARDS];
 const char *ranks[] = {"2", "3", "4", "5", "6", "7", "8", "9", "10", "J", "Q", "K", "A"};
 const char *suits[] = {"(S)", "(H)", "(D)", "(C)"};
 
 void initialize_deck() {
-    int index = 0;
-    for (int suit = 0; suit < NUM_SUITS; suit++) {
-        for (int rank = 0; rank < NUM_RANKS; rank++) {
-            deck[index].rank = rank + 2;
-            deck[index].suit = suit;
-            index++;
-        }
+    for (int index = 0; index < NUM_CARDS; index++) {
+        deck[index] = (CardIndex)index;
     }
 }
 
 void shuffle_deck() {
     for (int i = NUM_CARDS - 1; i > 0; i--) {
         int j = rand() % (i + 1);
-        Card temp = deck[i];
+        CardIndex temp = deck[i];
         deck[i] = deck[j];
         deck[j] = temp;
     }
 }
 
-void deal_cards(Card *source_deck, int *current_card, Card *hand, int size) {
+void deal_cards(CardIndex *source_deck, int *current_card, CardIndex *hand, int size) {
     for (int i = 0; i < size; i++) {
         hand[i] = source_deck[*current_card];
         (*current_card)++;
@@ -51,204 +46,212 @@ const char* combination_name(Combination combo) {
     }
 }
 
-int compare_cards(const void *a, const void *b) {
-    Card *cardA = (Card *)a;
-    Card *cardB = (Card *)b;
-    return cardB->rank - cardA->rank;
+static inline int popcount64(uint64_t bits) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(bits);
+#else
+    int count = 0;
+    for (; bits; bits &= bits - 1) count++;
+    return count;
+#endif
 }
 
-int find_straight_high(Card *cards, int num_cards) {
-    int ranks[15] = {0};
-    
-    for (int i = 0; i < num_cards; i++) {
-        ranks[cards[i].rank] = 1;
-        if (cards[i].rank == 14) ranks[1] = 1;
-    }
-    
-    for (int i = 14; i >= 5; i--) {
-        if (ranks[i] && ranks[i-1] && ranks[i-2] && ranks[i-3] && ranks[i-4]) {
-            return i;
-        }
-    }
-    
-    if (ranks[14] && ranks[2] && ranks[3] && ranks[4] && ranks[5]) {
-        return 5;
+static inline int lowest_bit(uint64_t bits) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(bits);
+#else
+    int index = 0;
+    while (!(bits & 1)) {
+        bits >>= 1;
+        index++;
     }
-    
-    return -1;
+    return index;
+#endif
+}
+
+static inline int highest_bit(uint64_t bits) {
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(bits);
+#else
+    int index = 63;
+    while (!(bits & ((uint64_t)1 << index))) index--;
+    return index;
+#endif
+}
+
+CardIndex card_to_index(Card card) {
+    return (CardIndex)(card.suit * NUM_RANKS + (card.rank - 2));
+}
+
+Card index_to_card(CardIndex index) {
+    Card card = {index % NUM_RANKS + 2, index / NUM_RANKS};
+    return card;
+}
+
+CardSet card_set_from_cards(const Card *cards, int num_cards) {
+    CardSet set = EMPTY_CARD_SET;
+    for (int i = 0; i < num_cards; i++) set |= CARD_BIT(card_to_index(cards[i]));
+    return set;
+}
+
+CardSet card_set_from_indices(const CardIndex *indices, int num_cards) {
+    CardSet set = EMPTY_CARD_SET;
+    for (int i = 0; i < num_cards; i++) set |= CARD_BIT(indices[i]);
+    return set;
+}
+
+int card_set_size(CardSet set) {
+    return popcount64(set);
+}
+
+int card_set_to_indices(CardSet set, CardIndex *indices) {
+    int count = 0;
+    for (; set; set &= set - 1) indices[count++] = (CardIndex)lowest_bit(set);
+    return count;
+}
+
+/* Ranks held in one suit, shifted so that bit r stands for rank r. */
+static inline int suit_ranks_of(CardSet set, int suit) {
+    return (int)((set >> (suit * NUM_RANKS)) & SUIT_RANK_BITS) << 2;
+}
+
+static int straight_high_from_mask(int rank_mask) {
+    if (rank_mask & (1 << 14)) rank_mask |= (1 << 1);
+
+    int runs = rank_mask & (rank_mask >> 1) & (rank_mask >> 2) & (rank_mask >> 3) & (rank_mask >> 4);
+    if (runs == 0) return -1;
+
+    return highest_bit((uint64_t)runs) + 4;
+}
+
+int find_straight_high(Card *cards, int num_cards) {
+    CardSet set = card_set_from_cards(cards, num_cards);
+    return straight_high_from_mask(suit_ranks_of(set, 0) | suit_ranks_of(set, 1) |
+                                   suit_ranks_of(set, 2) | suit_ranks_of(set, 3));
 }
 
 bool is_straight_flush(Card *cards, int num_cards, int flush_suit, int *high_card) {
-    Card suited_cards[num_cards];
-    int suited_count = 0;
-    
-    for (int i = 0; i < num_cards; i++) {
-        if (cards[i].suit == flush_suit) {
-            suited_cards[suited_count++] = cards[i];
-        }
-    }
+    int suited_ranks = suit_ranks_of(card_set_from_cards(cards, num_cards), flush_suit);
     
-    if (suited_count < 5) return false;
+    if (popcount64((uint64_t)suited_ranks) < 5) return false;
     
-    *high_card = find_straight_high(suited_cards, suited_count);
+    *high_card = straight_high_from_mask(suited_ranks);
     return (*high_card != -1);
 }
 
-HandEvaluation evaluate_hand(Card *hand, Card *community_cards, int community_size) {
-    Card all_cards[7];
-    HandEvaluation eval = {HIGH_CARD, 0, 0, 0, 0, 0};
-    
-    int total_cards = 0;
-    for (int i = 0; i < HAND_SIZE; i++) all_cards[total_cards++] = hand[i];
-    for (int i = 0; i < community_size; i++) all_cards[total_cards++] = community_cards[i];
-    
-    qsort(all_cards, total_cards, sizeof(Card), compare_cards);
-    
-    int rank_count[15] = {0};
-    int suit_count[4] = {0};
-    
-    for (int i = 0; i < total_cards; i++) {
-        rank_count[all_cards[i].rank]++;
-        suit_count[all_cards[i].suit]++;
-    }
-    
-    int flush_suit = -1;
-    for (int suit = 0; suit < 4; suit++) {
-        if (suit_count[suit] >= 5) {
-            flush_suit = suit;
-            break;
-        }
+/* Writes the highest ranks of rank_mask into consecutive evaluation slots. */
+static void fill_top_ranks(HandEvaluation *eval, int first_slot, int num_ranks, int rank_mask) {
+    int *slots[5] = {&eval->highest_card, &eval->second_highest_card, &eval->third_highest_card,
+                     &eval->fourth_highest_card, &eval->fifth_highest_card};
+
+    for (int i = 0; i < num_ranks && rank_mask; i++) {
+        int rank = highest_bit((uint64_t)rank_mask);
+        *slots[first_slot + i] = rank;
+        rank_mask &= ~(1 << rank);
     }
-    
-    int straight_high = find_straight_high(all_cards, total_cards);
-    
-    if (flush_suit != -1 && straight_high != -1) {
-        if (is_straight_flush(all_cards, total_cards, flush_suit, &straight_high)) {
-            eval.combination = (straight_high == 14) ? ROYAL_FLUSH : STRAIGHT_FLUSH;
-            eval.highest_card = straight_high;
+}
+
+/* Bit-sliced rank counts: bit r of rank_masks[k] is set when rank r appears more
+ * than k times. rank_bits adds one card for each rank it contains. */
+static inline void add_rank(int *rank_masks, int rank_bits) {
+    rank_masks[3] |= rank_masks[2] & rank_bits;
+    rank_masks[2] |= rank_masks[1] & rank_bits;
+    rank_masks[1] |= rank_masks[0] & rank_bits;
+    rank_masks[0] |= rank_bits;
+}
+
+/* Ranks a hand from its bit-sliced rank counts; flush_ranks holds the ranks of
+ * the flush suit when it has five or more cards, and is 0 otherwise. */
+static HandEvaluation evaluate_rank_masks(const int *rank_masks, int flush_ranks) {
+    HandEvaluation eval = {HIGH_CARD, 0, 0, 0, 0, 0};
+    int straight_high = straight_high_from_mask(rank_masks[0]);
+
+    if (flush_ranks && straight_high != -1) {
+        int flush_high = straight_high_from_mask(flush_ranks);
+        if (flush_high != -1) {
+            eval.combination = (flush_high == 14) ? ROYAL_FLUSH : STRAIGHT_FLUSH;
+            eval.highest_card = flush_high;
             return eval;
         }
     }
-    
-    for (int rank = 14; rank >= 2; rank--) {
-        if (rank_count[rank] == 4) {
-            eval.combination = FOUR_OF_A_KIND;
-            eval.highest_card = rank;
-            for (int i = 0; i < total_cards; i++) {
-                if (all_cards[i].rank != rank) {
-                    eval.second_highest_card = all_cards[i].rank;
-                    break;
-                }
-            }
-            return eval;
-        }
+
+    if (rank_masks[3]) {
+        eval.combination = FOUR_OF_A_KIND;
+        eval.highest_card = highest_bit((uint64_t)rank_masks[3]);
+        fill_top_ranks(&eval, 1, 1, rank_masks[0] & ~(1 << eval.highest_card));
+        return eval;
     }
-    
-    int three_rank = -1, two_rank = -1;
-    for (int rank = 14; rank >= 2; rank--) {
-        if (rank_count[rank] == 3) {
-            if (three_rank == -1) three_rank = rank;
-            else if (two_rank == -1) two_rank = rank;
-        } else if (rank_count[rank] == 2) {
-            if (two_rank == -1) two_rank = rank;
+
+    int trips = rank_masks[2];
+    int pairs = rank_masks[1] & ~rank_masks[2];
+
+    if (trips) {
+        int three_rank = highest_bit((uint64_t)trips);
+        int others = (trips & ~(1 << three_rank)) | pairs;
+        if (others) {
+            eval.combination = FULL_HOUSE;
+            eval.highest_card = three_rank;
+            eval.second_highest_card = highest_bit((uint64_t)others);
+            return eval;
         }
     }
-    if (three_rank != -1 && two_rank != -1) {
-        eval.combination = FULL_HOUSE;
-        eval.highest_card = three_rank;
-        eval.second_highest_card = two_rank;
-        return eval;
-    }
-    
-    if (flush_suit != -1) {
+
+    if (flush_ranks) {
         eval.combination = FLUSH;
-        int flush_cards = 0;
-        for (int i = 0; i < total_cards && flush_cards < 5; i++) {
-            if (all_cards[i].suit == flush_suit) {
-                switch(flush_cards) {
-                    case 0: eval.highest_card = all_cards[i].rank; break;
-                    case 1: eval.second_highest_card = all_cards[i].rank; break;
-                    case 2: eval.third_highest_card = all_cards[i].rank; break;
-                    case 3: eval.fourth_highest_card = all_cards[i].rank; break;
-                    case 4: eval.fifth_highest_card = all_cards[i].rank; break;
-                }
-                flush_cards++;
-            }
-        }
+        fill_top_ranks(&eval, 0, 5, flush_ranks);
         return eval;
     }
-    
+
     if (straight_high != -1) {
         eval.combination = STRAIGHT;
         eval.highest_card = straight_high;
         return eval;
     }
-    
-    for (int rank = 14; rank >= 2; rank--) {
-        if (rank_count[rank] == 3) {
-            eval.combination = THREE_OF_A_KIND;
-            eval.highest_card = rank;
-            int kickers = 0;
-            for (int i = 0; i < total_cards && kickers < 2; i++) {
-                if (all_cards[i].rank != rank) {
-                    if (kickers == 0) eval.second_highest_card = all_cards[i].rank;
-                    else eval.third_highest_card = all_cards[i].rank;
-                    kickers++;
-                }
-            }
-            return eval;
-        }
-    }
-    
-    int pairs[2] = {-1, -1};
-    for (int rank = 14; rank >= 2; rank--) {
-        if (rank_count[rank] == 2) {
-            if (pairs[0] == -1) pairs[0] = rank;
-            else if (pairs[1] == -1) pairs[1] = rank;
-        }
+
+    if (trips) {
+        eval.combination = THREE_OF_A_KIND;
+        eval.highest_card = highest_bit((uint64_t)trips);
+        fill_top_ranks(&eval, 1, 2, rank_masks[0] & ~trips);
+        return eval;
     }
-    if (pairs[0] != -1 && pairs[1] != -1) {
+
+    if (popcount64((uint64_t)pairs) >= 2) {
         eval.combination = TWO_PAIR;
-        eval.highest_card = pairs[0];
-        eval.second_highest_card = pairs[1];
-        for (int i = 0; i < total_cards; i++) {
-            if (all_cards[i].rank != pairs[0] && all_cards[i].rank != pairs[1]) {
-                eval.third_highest_card = all_cards[i].rank;
-                break;
-            }
-        }
+        fill_top_ranks(&eval, 0, 2, pairs);
+        int used = (1 << eval.highest_card) | (1 << eval.second_highest_card);
+        fill_top_ranks(&eval, 2, 1, rank_masks[0] & ~used);
         return eval;
     }
-    
-    for (int rank = 14; rank >= 2; rank--) {
-        if (rank_count[rank] == 2) {
-            eval.combination = PAIR;
-            eval.highest_card = rank;
-            int kickers = 0;
-            for (int i = 0; i < total_cards && kickers < 3; i++) {
-                if (all_cards[i].rank != rank) {
-                    switch(kickers) {
-                        case 0: eval.second_highest_card = all_cards[i].rank; break;
-                        case 1: eval.third_highest_card = all_cards[i].rank; break;
-                        case 2: eval.fourth_highest_card = all_cards[i].rank; break;
-                    }
-                    kickers++;
-                }
-            }
-            return eval;
-        }
+
+    if (pairs) {
+        eval.combination = PAIR;
+        eval.highest_card = highest_bit((uint64_t)pairs);
+        fill_top_ranks(&eval, 1, 3, rank_masks[0] & ~pairs);
+        return eval;
     }
-    
-    eval.combination = HIGH_CARD;
-    eval.highest_card = all_cards[0].rank;
-    eval.second_highest_card = all_cards[1].rank;
-    eval.third_highest_card = all_cards[2].rank;
-    eval.fourth_highest_card = all_cards[3].rank;
-    eval.fifth_highest_card = all_cards[4].rank;
-    
+
+    fill_top_ranks(&eval, 0, 5, rank_masks[0]);
     return eval;
 }
 
+HandEvaluation evaluate_card_set(CardSet cards) {
+    int rank_masks[4] = {0, 0, 0, 0};
+    int flush_ranks = 0;
+
+    for (int suit = 0; suit < NUM_SUITS; suit++) {
+        int suited = suit_ranks_of(cards, suit);
+        add_rank(rank_masks, suited);
+        if (popcount64((uint64_t)suited) >= 5) flush_ranks = suited;
+    }
+
+    return evaluate_rank_masks(rank_masks, flush_ranks);
+}
+
+HandEvaluation evaluate_hand(Card *hand, Card *community_cards, int community_size) {
+    return evaluate_card_set(card_set_from_cards(hand, HAND_SIZE) |
+                             card_set_from_cards(community_cards, community_size));
+}
+
 int compare_evaluations(HandEvaluation eval1, HandEvaluation eval2) {
     if (eval1.combination != eval2.combination) {
         return eval1.combination - eval2.combination;
@@ -279,60 +282,293 @@ bool is_hand_better(Card *hand1, Card *hand2, Card *community_cards, int communi
     return compare_evaluations(eval1, eval2) > 0;
 }
 
-int calculate_win_probability(Card *player_hand, Card *community_cards, int community_size) {
-    int wins = 0, ties = 0;
-    
-    for (int sim = 0; sim < MONTE_CARLO_SIMULATIONS; sim++) {
-        Card temp_deck[NUM_CARDS];
-        int temp_deck_size = 0;
-        
-        for (int i = 0; i < NUM_CARDS; i++) {
-            bool card_used = false;
-            
-            for (int j = 0; j < HAND_SIZE; j++) {
-                if (deck[i].rank == player_hand[j].rank && deck[i].suit == player_hand[j].suit) {
-                    card_used = true;
-                    break;
-                }
+/* Precomputes everything the board contributes, so each holding only adds two cards.
+ * With at most five board cards only one suit can hold three or more, so that is
+ * the only suit that can still make a flush. */
+void analyze_board(CardSet board, BoardAnalysis *analysis) {
+    memset(analysis, 0, sizeof(*analysis));
+
+    analysis->cards = board;
+    analysis->flush_suit = -1;
+    for (int suit = 0; suit < NUM_SUITS; suit++) {
+        int suited = suit_ranks_of(analysis->cards, suit);
+        add_rank(analysis->rank_masks, suited);
+        if (popcount64((uint64_t)suited) >= 3) {
+            analysis->flush_suit = suit;
+            analysis->flush_ranks = suited;
+        }
+    }
+}
+
+HandEvaluation evaluate_with_board(const BoardAnalysis *analysis, CardSet hole_cards) {
+    int rank_masks[4] = {analysis->rank_masks[0], analysis->rank_masks[1],
+                         analysis->rank_masks[2], analysis->rank_masks[3]};
+    int flush_ranks = 0;
+
+    for (int suit = 0; suit < NUM_SUITS; suit++) {
+        add_rank(rank_masks, suit_ranks_of(hole_cards, suit));
+    }
+    if (analysis->flush_suit >= 0) {
+        flush_ranks = analysis->flush_ranks | suit_ranks_of(hole_cards, analysis->flush_suit);
+        if (popcount64((uint64_t)flush_ranks) < 5) flush_ranks = 0;
+    }
+
+    return evaluate_rank_masks(rank_masks, flush_ranks);
+}
+
+/* Packs an evaluation into one int that orders exactly like compare_evaluations. */
+int evaluation_score(HandEvaluation eval) {
+    return (eval.combination << 20) | (eval.highest_card << 16) | (eval.second_highest_card << 12) |
+           (eval.third_highest_card << 8) | (eval.fourth_highest_card << 4) | eval.fifth_highest_card;
+}
+
+static int compare_holdings(const void *a, const void *b) {
+    const RankedHolding *holdingA = (const RankedHolding *)a;
+    const RankedHolding *holdingB = (const RankedHolding *)b;
+    return holdingA->score - holdingB->score;
+}
+
+int rank_board_holdings(CardSet board, CardSet dead_cards, BoardRanking *ranking) {
+    CardIndex live[NUM_CARDS];
+    int num_live = card_set_to_indices(FULL_DECK_SET & ~board & ~dead_cards, live);
+
+    analyze_board(board, &ranking->board);
+    ranking->count = 0;
+
+    for (int first = 0; first < num_live; first++) {
+        for (int second = first + 1; second < num_live; second++) {
+            RankedHolding *holding = &ranking->holdings[ranking->count++];
+            holding->hole[0] = live[first];
+            holding->hole[1] = live[second];
+            holding->score = evaluation_score(evaluate_with_board(&ranking->board,
+                                                                  CARD_BIT(live[first]) | CARD_BIT(live[second])));
+        }
+    }
+
+    qsort(ranking->holdings, ranking->count, sizeof(RankedHolding), compare_holdings);
+
+    memset(ranking->position, -1, sizeof(ranking->position));
+    for (int i = 0; i < ranking->count; i++) {
+        CardIndex first = ranking->holdings[i].hole[0];
+        CardIndex second = ranking->holdings[i].hole[1];
+        ranking->position[first][second] = (short)i;
+        ranking->position[second][first] = (short)i;
+    }
+
+    return ranking->count;
+}
+
+/* Index of the first holding whose score is not below the given one. */
+static int lower_bound_score(const BoardRanking *ranking, int score) {
+    int low = 0, high = ranking->count;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (ranking->holdings[mid].score < score) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+EquityTally board_equity(const BoardRanking *ranking, const CardIndex *hand) {
+    EquityTally tally = {0, 0, ranking->count};
+    int hero_score = evaluation_score(evaluate_with_board(&ranking->board, card_set_from_indices(hand, HAND_SIZE)));
+
+    tally.wins = lower_bound_score(ranking, hero_score);
+    tally.ties = lower_bound_score(ranking, hero_score + 1) - tally.wins;
+
+    for (int i = 0; i < HAND_SIZE; i++) {
+        for (int other = 0; other < NUM_CARDS; other++) {
+            if (i == 1 && other == hand[0]) continue;
+
+            int pos = ranking->position[hand[i]][other];
+            if (pos < 0) continue;
+
+            int score = ranking->holdings[pos].score;
+            if (score < hero_score) tally.wins--;
+            else if (score == hero_score) tally.ties--;
+            tally.total--;
+        }
+    }
+
+    return tally;
+}
+
+EquityTally board_range_equity(const BoardRanking *ranking, const CardIndex *hand,
+                               const CardIndex *range_hands, int range_size) {
+    EquityTally tally = {0, 0, 0};
+    CardSet hero = card_set_from_indices(hand, HAND_SIZE);
+    int hero_score = evaluation_score(evaluate_with_board(&ranking->board, hero));
+
+    for (int i = 0; i < range_size; i++) {
+        CardIndex first = range_hands[i * HAND_SIZE];
+        CardIndex second = range_hands[i * HAND_SIZE + 1];
+        if ((CARD_BIT(first) | CARD_BIT(second)) & hero) continue;
+
+        int pos = ranking->position[first][second];
+        if (pos < 0) continue;
+
+        int score = ranking->holdings[pos].score;
+        if (score < hero_score) tally.wins++;
+        else if (score == hero_score) tally.ties++;
+        tally.total++;
+    }
+
+    return tally;
+}
+
+double tally_equity(EquityTally tally) {
+    if (tally.total == 0) return 0.0;
+    return (tally.wins + tally.ties * 0.5) / tally.total;
+}
+
+/* Scores every live hand against one shared board analysis and pays out the
+ * main pot and each side pot to the best eligible hands. contributions[] are
+ * the chips each player put in; folded players (folded may be NULL) pay but
+ * cannot win. Split pots give odd chips to the lowest seats first, so seat 0
+ * should be the first seat left of the button. Chips nobody live can claim
+ * are returned to the players who put them in. Returns false, with an empty
+ * result, when num_players is outside 1..MAX_PLAYERS. */
+bool resolve_showdown(CardIndex hole_cards[][HAND_SIZE], int num_players, CardSet board,
+                      const int *contributions, const bool *folded, ShowdownResult *result) {
+    memset(result, 0, sizeof(*result));
+    if (num_players < 1 || num_players > MAX_PLAYERS) return false;
+
+    BoardAnalysis analysis;
+    analyze_board(board, &analysis);
+
+    int levels[MAX_PLAYERS];
+    int num_levels = 0;
+    int best_score = -1;
+
+    result->num_players = num_players;
+    result->winners = 0;
+
+    for (int player = 0; player < num_players; player++) {
+        result->payout[player] = 0;
+        result->score[player] = -1;
+        if (folded == NULL || !folded[player]) {
+            CardSet hole = CARD_BIT(hole_cards[player][0]) | CARD_BIT(hole_cards[player][1]);
+            result->score[player] = evaluation_score(evaluate_with_board(&analysis, hole));
+            if (result->score[player] > best_score) {
+                best_score = result->score[player];
+                result->winners = 1u << player;
+            } else if (result->score[player] == best_score) {
+                result->winners |= 1u << player;
             }
-            
-            for (int j = 0; j < community_size; j++) {
-                if (deck[i].rank == community_cards[j].rank && deck[i].suit == community_cards[j].suit) {
-                    card_used = true;
-                    break;
+        }
+
+        int level = contributions[player];
+        int pos = num_levels;
+        while (pos > 0 && levels[pos - 1] > level) pos--;
+        if (level > 0 && (pos == 0 || levels[pos - 1] != level)) {
+            memmove(&levels[pos + 1], &levels[pos], (num_levels - pos) * sizeof(int));
+            levels[pos] = level;
+            num_levels++;
+        }
+    }
+
+    int previous = 0;
+    for (int i = 0; i < num_levels; i++) {
+        int pot = 0, pot_best = -1, num_winners = 0;
+        unsigned int pot_winners = 0;
+
+        for (int player = 0; player < num_players; player++) {
+            int paid = contributions[player];
+            pot += (paid < levels[i] ? paid : levels[i]) - (paid < previous ? paid : previous);
+
+            if (paid >= levels[i] && result->score[player] >= 0) {
+                if (result->score[player] > pot_best) {
+                    pot_best = result->score[player];
+                    pot_winners = 1u << player;
+                    num_winners = 1;
+                } else if (result->score[player] == pot_best) {
+                    pot_winners |= 1u << player;
+                    num_winners++;
                 }
             }
-            
-            if (!card_used) {
-                temp_deck[temp_deck_size++] = deck[i];
+        }
+
+        if (num_winners == 0) {
+            for (int player = 0; player < num_players; player++) {
+                int paid = contributions[player];
+                result->payout[player] += (paid < levels[i] ? paid : levels[i]) - (paid < previous ? paid : previous);
+            }
+        } else {
+            int share = pot / num_winners;
+            int odd_chips = pot % num_winners;
+            for (int player = 0; player < num_players; player++) {
+                if (pot_winners & (1u << player)) {
+                    result->payout[player] += share;
+                    if (odd_chips > 0) {
+                        result->payout[player]++;
+                        odd_chips--;
+                    }
+                }
             }
         }
-        
-        for (int i = temp_deck_size - 1; i > 0; i--) {
-            int j = rand() % (i + 1);
-            Card temp = temp_deck[i];
-            temp_deck[i] = temp_deck[j];
-            temp_deck[j] = temp;
+
+        previous = levels[i];
+    }
+
+    return true;
+}
+
+uint32_t poker_random(uint32_t *state) {
+    uint32_t x = *state ? *state : 0x9E3779B9u;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static int random_below(uint32_t *seed, int bound) {
+    if (seed == NULL) return rand() % bound;
+    return (int)(poker_random(seed) % (uint32_t)bound);
+}
+
+/* Adds Monte Carlo showdowns to the tally. A NULL seed draws from the shared
+ * rand() stream; a caller-owned seed makes it safe to run on a worker thread. */
+void simulate_equity(const CardIndex *player_hand, CardSet known_board,
+                     int simulations, uint32_t *seed, EquityTally *tally) {
+    CardSet hero = card_set_from_indices(player_hand, HAND_SIZE);
+    CardIndex live[NUM_CARDS];
+    int num_live = card_set_to_indices(FULL_DECK_SET & ~(hero | known_board), live);
+    int num_draws = HAND_SIZE + (5 - card_set_size(known_board));
+
+    for (int sim = 0; sim < simulations; sim++) {
+        for (int i = 0; i < num_draws; i++) {
+            int j = i + random_below(seed, num_live - i);
+            CardIndex temp = live[i];
+            live[i] = live[j];
+            live[j] = temp;
         }
         
-        Card opponent_hand[HAND_SIZE];
-        Card simulated_community[5];
-        memcpy(simulated_community, community_cards, community_size * sizeof(Card));
-        
-        int current_card = 0;
-        deal_cards(temp_deck, &current_card, opponent_hand, HAND_SIZE);
+        CardSet opponent = CARD_BIT(live[0]) | CARD_BIT(live[1]);
+        CardSet board = known_board;
+        for (int i = HAND_SIZE; i < num_draws; i++) board |= CARD_BIT(live[i]);
         
-        for (int i = community_size; i < 5; i++) {
-            simulated_community[i] = temp_deck[current_card++];
-        }
-        
-        HandEvaluation player_eval = evaluate_hand(player_hand, simulated_community, 5);
-        HandEvaluation opponent_eval = evaluate_hand(opponent_hand, simulated_community, 5);
+        int player_score = evaluation_score(evaluate_card_set(hero | board));
+        int opponent_score = evaluation_score(evaluate_card_set(opponent | board));
         
-        int result = compare_evaluations(player_eval, opponent_eval);
-        if (result > 0) wins++;
-        else if (result == 0) ties++;
+        if (player_score > opponent_score) tally->wins++;
+        else if (player_score == opponent_score) tally->ties++;
+        tally->total++;
     }
-    
-    return (wins * 100 + ties * 50) / MONTE_CARLO_SIMULATIONS;
+}
+
+int calculate_win_probability(Card *player_hand, Card *community_cards, int community_size) {
+    EquityTally tally = {0, 0, 0};
+    CardIndex hand[HAND_SIZE] = {card_to_index(player_hand[0]), card_to_index(player_hand[1])};
+    CardSet board = card_set_from_cards(community_cards, community_size);
+
+    if (community_size == 5) {
+        BoardRanking ranking;
+        rank_board_holdings(board, card_set_from_indices(hand, HAND_SIZE), &ranking);
+        tally = board_equity(&ranking, hand);
+    } else {
+        simulate_equity(hand, board, MONTE_CARLO_SIMULATIONS, NULL, &tally);
+    }
+
+    return (tally.wins * 100 + tally.ties * 50) / tally.total;
 }
@@ -6,6 +6,7 @@
 #include <string.h>
 #include <time.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #define NUM_CARDS 52
 #define NUM_RANKS 13
@@ -14,6 +15,8 @@
 #define FLOP_SIZE 3
 #define TURN_RIVER_SIZE 1
 #define MONTE_CARLO_SIMULATIONS 1000
+#define MAX_BOARD_HOLDINGS 1081
+#define MAX_PLAYERS 10
 
 typedef enum {
     HIGH_CARD = 0,
@@ -42,18 +45,71 @@ typedef struct {
     int fifth_highest_card;
 } HandEvaluation;
 
+/* Compact card encoding: index = suit * 13 + (rank - 2), the initialize_deck() order.
+ * A CardSet holds one bit per index. */
+typedef uint8_t CardIndex;
+typedef uint64_t CardSet;
+
+#define EMPTY_CARD_SET ((CardSet)0)
+#define FULL_DECK_SET ((((CardSet)1) << NUM_CARDS) - 1)
+#define CARD_BIT(index) (((CardSet)1) << (index))
+#define SUIT_RANK_BITS 0x1FFF
+
+/* rank_masks[k] has bit r set when rank r appears more than k times on the board;
+ * flush_suit is the only suit that can still complete a flush (-1 if none). */
+typedef struct {
+    CardSet cards;
+    int rank_masks[4];
+    int flush_suit;
+    int flush_ranks;
+} BoardAnalysis;
+
+typedef struct {
+    CardIndex hole[HAND_SIZE];
+    int score;
+} RankedHolding;
+
+/* All hole-card pairs on a 5-card board, sorted weakest first. */
+typedef struct {
+    BoardAnalysis board;
+    int count;
+    RankedHolding holdings[MAX_BOARD_HOLDINGS];
+    short position[NUM_CARDS][NUM_CARDS];
+} BoardRanking;
+
+typedef struct {
+    int wins;
+    int ties;
+    int total;
+} EquityTally;
+
+typedef struct {
+    int num_players;
+    int score[MAX_PLAYERS];
+    int payout[MAX_PLAYERS];
+    unsigned int winners;
+} ShowdownResult;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-extern Card deck[NUM_CARDS];
+extern CardIndex deck[NUM_CARDS];
 extern const char *ranks[];
 extern const char *suits[];
 
+CardIndex card_to_index(Card card);
+Card index_to_card(CardIndex index);
+CardSet card_set_from_cards(const Card *cards, int num_cards);
+CardSet card_set_from_indices(const CardIndex *indices, int num_cards);
+int card_set_size(CardSet set);
+int card_set_to_indices(CardSet set, CardIndex *indices);
+
 void initialize_deck();
 void shuffle_deck();
-void deal_cards(Card *source_deck, int *current_card, Card *hand, int size);
+void deal_cards(CardIndex *source_deck, int *current_card, CardIndex *hand, int size);
 HandEvaluation evaluate_hand(Card *hand, Card *community_cards, int community_size);
+HandEvaluation evaluate_card_set(CardSet cards);
 int compare_evaluations(HandEvaluation eval1, HandEvaluation eval2);
 bool is_hand_better(Card *hand1, Card *hand2, Card *community_cards, int community_size);
 int calculate_win_probability(Card *player_hand, Card *community_cards, int community_size);
@@ -61,6 +117,19 @@ void print_card(Card card);
 int find_straight_high(Card *cards, int num_cards);
 bool is_straight_flush(Card *cards, int num_cards, int flush_suit, int *high_card);
 const char* combination_name(Combination combo);
+void analyze_board(CardSet board, BoardAnalysis *analysis);
+HandEvaluation evaluate_with_board(const BoardAnalysis *analysis, CardSet hole_cards);
+int evaluation_score(HandEvaluation eval);
+int rank_board_holdings(CardSet board, CardSet dead_cards, BoardRanking *ranking);
+EquityTally board_equity(const BoardRanking *ranking, const CardIndex *hand);
+EquityTally board_range_equity(const BoardRanking *ranking, const CardIndex *hand,
+                               const CardIndex *range_hands, int range_size);
+double tally_equity(EquityTally tally);
+bool resolve_showdown(CardIndex hole_cards[][HAND_SIZE], int num_players, CardSet board,
+                      const int *contributions, const bool *folded, ShowdownResult *result);
+uint32_t poker_random(uint32_t *state);
+void simulate_equity(const CardIndex *player_hand, CardSet known_board,
+                     int simulations, uint32_t *seed, EquityTally *tally);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,98 @@
+#include "poker_input.h"
+
+#define ESCAPE_CHAR 0x1B
+
+enum {
+    ESCAPE_NONE,
+    ESCAPE_START,
+    ESCAPE_CSI,
+    ESCAPE_SS3
+};
+
+void start_line_editing(InputBuffer *input, unsigned char erase_char, unsigned char kill_char,
+                        unsigned char eof_char) {
+    input->editing = true;
+    input->escape_state = ESCAPE_NONE;
+    input->erase_char = erase_char;
+    input->kill_char = kill_char;
+    input->eof_char = eof_char;
+}
+
+static bool store_input(InputBuffer *input, char c) {
+    if (input->length >= INPUT_BUFFER_SIZE) return false;
+    input->text[input->length++] = c;
+    return true;
+}
+
+/* Removes the last character of the line being typed; completed lines stay. */
+static bool erase_input(InputBuffer *input, FILE *echo) {
+    if (input->length == 0 || input->text[input->length - 1] == '\n') return false;
+    input->length--;
+    if (echo != NULL) fputs("\b \b", echo);
+    return true;
+}
+
+/* Skips "ESC x", "ESC O x" and "ESC [ params final" (arrow and function keys). */
+static void skip_escape(InputBuffer *input, unsigned char c) {
+    if (input->escape_state == ESCAPE_START) {
+        if (c == '[') input->escape_state = ESCAPE_CSI;
+        else if (c == 'O') input->escape_state = ESCAPE_SS3;
+        else input->escape_state = ESCAPE_NONE;
+    } else if (input->escape_state == ESCAPE_SS3 || (c >= 0x40 && c <= 0x7E)) {
+        input->escape_state = ESCAPE_NONE;
+    }
+}
+
+/* The erase, kill and end-of-file characters come from the saved termios; a
+ * zero entry means the character is disabled. */
+void feed_input(InputBuffer *input, const char *bytes, int count, FILE *echo) {
+    for (int i = 0; i < count && !input->closed; i++) {
+        unsigned char c = (unsigned char)bytes[i];
+        if (c == '\r') c = '\n';
+
+        if (!input->editing) {
+            store_input(input, (char)c);
+            continue;
+        }
+
+        if (input->escape_state != ESCAPE_NONE) {
+            skip_escape(input, c);
+        } else if (c == ESCAPE_CHAR) {
+            input->escape_state = ESCAPE_START;
+        } else if (input->eof_char != 0 && c == input->eof_char) {
+            input->closed = true;
+        } else if ((input->erase_char != 0 && c == input->erase_char) || c == '\b') {
+            erase_input(input, echo);
+        } else if (input->kill_char != 0 && c == input->kill_char) {
+            while (erase_input(input, echo)) continue;
+        } else if (c == '\n' || (c >= 0x20 && c < 0x7F)) {
+            if (store_input(input, (char)c) && echo != NULL) fputc(c, echo);
+        }
+    }
+}
+
+/* True while nothing has been typed after the last complete line. */
+bool input_line_empty(const InputBuffer *input) {
+    return input->length == 0 || input->text[input->length - 1] == '\n';
+}
+
+/* Takes the next non-blank character from a completed line, like scanf(" %c").
+ * Once input is closed a final line without a newline counts as completed. */
+bool take_action(InputBuffer *input, char *action) {
+    int start = 0;
+    while (start < input->length && (input->text[start] == ' ' || input->text[start] == '\t' ||
+                                     input->text[start] == '\n')) {
+        start++;
+    }
+    if (start == input->length) {
+        input->length = 0;
+        return false;
+    }
+
+    if (!input->closed && memchr(&input->text[start], '\n', input->length - start) == NULL) return false;
+
+    *action = input->text[start];
+    input->length -= start + 1;
+    memmove(input->text, &input->text[start + 1], input->length);
+    return true;
+}
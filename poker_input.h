@@ -0,0 +1,37 @@
+#ifndef POKER_INPUT_H
+#define POKER_INPUT_H
+
+#include "poker.h"
+
+#define INPUT_BUFFER_SIZE 256
+
+/* Player input collected from raw bytes. With line editing on (a terminal in
+ * non-canonical mode) the erase, kill and end-of-file characters are applied
+ * here, escape sequences and other control bytes are dropped, and accepted
+ * input is echoed. Without it (a pipe or file) bytes are stored as they come. */
+typedef struct {
+    char text[INPUT_BUFFER_SIZE];
+    int length;
+    bool closed;
+    bool editing;
+    int escape_state;
+    unsigned char erase_char;
+    unsigned char kill_char;
+    unsigned char eof_char;
+} InputBuffer;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void start_line_editing(InputBuffer *input, unsigned char erase_char, unsigned char kill_char,
+                        unsigned char eof_char);
+void feed_input(InputBuffer *input, const char *bytes, int count, FILE *echo);
+bool input_line_empty(const InputBuffer *input);
+bool take_action(InputBuffer *input, char *action);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,115 @@
+#include "poker_log.h"
+
+#define TAG_SESSION 'S'
+#define TAG_HAND 'H'
+#define MAX_RECORD_SIZE (4 + 2 * MAX_PLAYERS + 5 + 2)
+
+static bool open_buffered(GameLog *log, const char *path, const char *mode) {
+    log->used = 0;
+    log->buffer = (unsigned char *)malloc(LOG_BUFFER_SIZE);
+    log->file = (log->buffer != NULL) ? fopen(path, mode) : NULL;
+    if (log->file == NULL) {
+        free(log->buffer);
+        log->buffer = NULL;
+        return false;
+    }
+    return true;
+}
+
+static bool flush_game_log(GameLog *log) {
+    size_t size = (size_t)log->used;
+    log->used = 0;
+    return size == 0 || fwrite(log->buffer, 1, size, log->file) == size;
+}
+
+/* Records are encoded straight into the log's own buffer and reach the file
+ * in LOG_BUFFER_SIZE writes; a record already holds its cards as CardIndex
+ * bytes, so a hand costs two small copies, not an fwrite. */
+bool open_game_log(GameLog *log, const char *path, uint32_t seed) {
+    if (!open_buffered(log, path, "ab")) return false;
+    setvbuf(log->file, NULL, _IONBF, 0);
+
+    unsigned char *session = log->buffer;
+    session[0] = TAG_SESSION;
+    session[1] = LOG_VERSION;
+    for (int i = 0; i < 4; i++) session[2 + i] = (unsigned char)(seed >> (8 * i));
+    log->used = 6;
+    return true;
+}
+
+bool log_hand(GameLog *log, const HandRecord *record) {
+    if (log->used + MAX_RECORD_SIZE > LOG_BUFFER_SIZE && !flush_game_log(log)) return false;
+
+    unsigned char *bytes = log->buffer + log->used;
+    int size = 0;
+
+    bytes[size++] = TAG_HAND;
+    bytes[size++] = (unsigned char)record->flags;
+    bytes[size++] = (unsigned char)record->num_players;
+    bytes[size++] = (unsigned char)record->board_size;
+    memcpy(&bytes[size], record->hole_cards, HAND_SIZE * record->num_players);
+    size += HAND_SIZE * record->num_players;
+    memcpy(&bytes[size], record->board, record->board_size);
+    size += record->board_size;
+    bytes[size++] = record->winners & 0xFF;
+    bytes[size++] = (record->winners >> 8) & 0xFF;
+
+    log->used += size;
+    return true;
+}
+
+bool close_game_log(GameLog *log) {
+    bool ok = true;
+    if (log->file != NULL) {
+        ok = flush_game_log(log);
+        if (fclose(log->file) != 0) ok = false;
+    }
+    free(log->buffer);
+    log->file = NULL;
+    log->buffer = NULL;
+    return ok;
+}
+
+bool open_log_reader(GameLog *log, const char *path) {
+    if (!open_buffered(log, path, "rb")) return false;
+    setvbuf(log->file, (char *)log->buffer, _IOFBF, LOG_BUFFER_SIZE);
+    return true;
+}
+
+static bool read_bytes(GameLog *log, unsigned char *bytes, int size) {
+    return fread(bytes, 1, size, log->file) == (size_t)size;
+}
+
+LogRecordType read_log_record(GameLog *log, uint32_t *seed, HandRecord *record) {
+    unsigned char bytes[MAX_RECORD_SIZE];
+
+    int tag = fgetc(log->file);
+    if (tag == EOF) return LOG_RECORD_END;
+
+    if (tag == TAG_SESSION) {
+        if (!read_bytes(log, bytes, 5) || bytes[0] != LOG_VERSION) return LOG_RECORD_ERROR;
+        *seed = (uint32_t)bytes[1] | ((uint32_t)bytes[2] << 8) | ((uint32_t)bytes[3] << 16) | ((uint32_t)bytes[4] << 24);
+        return LOG_RECORD_SESSION;
+    }
+
+    if (tag != TAG_HAND || !read_bytes(log, bytes, 3)) return LOG_RECORD_ERROR;
+
+    record->flags = bytes[0];
+    record->num_players = bytes[1];
+    record->board_size = bytes[2];
+    if (record->num_players < 1 || record->num_players > MAX_PLAYERS || record->board_size > 5) {
+        return LOG_RECORD_ERROR;
+    }
+
+    int num_cards = 2 * record->num_players + record->board_size;
+    if (!read_bytes(log, bytes, num_cards + 2)) return LOG_RECORD_ERROR;
+
+    for (int i = 0; i < num_cards; i++) {
+        if (bytes[i] >= NUM_CARDS) return LOG_RECORD_ERROR;
+    }
+    memcpy(record->hole_cards, bytes, HAND_SIZE * record->num_players);
+    memcpy(record->board, &bytes[HAND_SIZE * record->num_players], record->board_size);
+    record->winners = bytes[num_cards] | (bytes[num_cards + 1] << 8);
+
+    return LOG_RECORD_HAND;
+}
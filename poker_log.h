@@ -0,0 +1,53 @@
+#ifndef POKER_LOG_H
+#define POKER_LOG_H
+
+#include "poker.h"
+
+#define LOG_VERSION 1
+#define LOG_BUFFER_SIZE (1 << 16)
+
+/* On-disk format, append-only, all integers little-endian:
+ *   session: 'S' | u8 version | u32 seed
+ *   hand:    'H' | u8 flags | u8 num_players | u8 board_size |
+ *            u8 card[2 * num_players + board_size] | u16 winners
+ * A card is stored as its one-byte CardIndex. */
+typedef enum {
+    LOG_RECORD_SESSION,
+    LOG_RECORD_HAND,
+    LOG_RECORD_END,
+    LOG_RECORD_ERROR
+} LogRecordType;
+
+#define HAND_FOLDED 0x01
+
+typedef struct {
+    int flags;
+    int num_players;
+    CardIndex hole_cards[MAX_PLAYERS][HAND_SIZE];
+    int board_size;
+    CardIndex board[5];
+    unsigned int winners;
+} HandRecord;
+
+typedef struct {
+    FILE *file;
+    unsigned char *buffer;
+    int used;
+} GameLog;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool open_game_log(GameLog *log, const char *path, uint32_t seed);
+bool log_hand(GameLog *log, const HandRecord *record);
+bool close_game_log(GameLog *log);
+
+bool open_log_reader(GameLog *log, const char *path);
+LogRecordType read_log_record(GameLog *log, uint32_t *seed, HandRecord *record);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
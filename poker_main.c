@@ -1,35 +1,176 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "poker.h"
+#include "poker_log.h"
+#include "poker_input.h"
+#include <pthread.h>
+#include <signal.h>
+#include <sys/select.h>
+#include <termios.h>
+#include <unistd.h>
+
+#define EQUITY_BATCH_SIZE 1000
+#define EQUITY_SAMPLE_BUDGET 200000
+#define EQUITY_REFRESH_MS 100
+
+/* Background Monte Carlo worker; refines the equity estimate until the
+ * sample budget is reached or the player acts. */
+typedef struct {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    bool running;
+    bool cancelled;
+    CardIndex hand[HAND_SIZE];
+    CardSet community;
+    uint32_t seed;
+    EquityTally tally;
+} EquityWorker;
+
+static EquityWorker equity_worker = {.lock = PTHREAD_MUTEX_INITIALIZER};
 
-Card player_hand[HAND_SIZE];
-Card computer_hand[HAND_SIZE];
-Card community_cards[5];
+/* Player input is read from the descriptor into our own buffer rather than
+ * through stdio, so answers that arrived together are never hidden from
+ * select(). On a terminal the line is edited and echoed by feed_input(),
+ * which tells the prompt whether the player has started typing. */
+static InputBuffer player_input;
+static bool terminal_input = false;
+static struct termios saved_termios;
+
+CardIndex player_hand[HAND_SIZE];
+CardIndex computer_hand[HAND_SIZE];
+CardIndex community_cards[5];
 int community_size = 0;
+GameLog game_log;
+bool recording = false;
 
-void print_hand(Card *hand, int size, const char *name) {
+void print_hand(CardIndex *hand, int size, const char *name) {
     printf("%s: ", name);
     for (int i = 0; i < size; i++) {
-        print_card(hand[i]);
+        print_card(index_to_card(hand[i]));
         printf(" ");
     }
     printf("\n");
 }
 
+static void *equity_worker_main(void *arg) {
+    EquityWorker *worker = (EquityWorker *)arg;
+
+    while (true) {
+        pthread_mutex_lock(&worker->lock);
+        bool stop = worker->cancelled || worker->tally.total >= EQUITY_SAMPLE_BUDGET;
+        pthread_mutex_unlock(&worker->lock);
+        if (stop) break;
+
+        EquityTally batch = {0, 0, 0};
+        simulate_equity(worker->hand, worker->community, EQUITY_BATCH_SIZE, &worker->seed, &batch);
+
+        pthread_mutex_lock(&worker->lock);
+        worker->tally.wins += batch.wins;
+        worker->tally.ties += batch.ties;
+        worker->tally.total += batch.total;
+        pthread_mutex_unlock(&worker->lock);
+    }
+
+    return NULL;
+}
+
+void start_equity_worker() {
+    equity_worker.cancelled = false;
+    equity_worker.tally = (EquityTally){0, 0, 0};
+    memcpy(equity_worker.hand, player_hand, sizeof(player_hand));
+    equity_worker.community = card_set_from_indices(community_cards, community_size);
+    equity_worker.seed = (uint32_t)rand();
+
+    equity_worker.running = (pthread_create(&equity_worker.thread, NULL, equity_worker_main, &equity_worker) == 0);
+    if (!equity_worker.running) {
+        simulate_equity(player_hand, equity_worker.community,
+                        MONTE_CARLO_SIMULATIONS, &equity_worker.seed, &equity_worker.tally);
+    }
+}
+
+void stop_equity_worker() {
+    if (!equity_worker.running) return;
+
+    pthread_mutex_lock(&equity_worker.lock);
+    equity_worker.cancelled = true;
+    pthread_mutex_unlock(&equity_worker.lock);
+
+    pthread_join(equity_worker.thread, NULL);
+    equity_worker.running = false;
+}
+
+EquityTally equity_snapshot() {
+    pthread_mutex_lock(&equity_worker.lock);
+    EquityTally tally = equity_worker.tally;
+    pthread_mutex_unlock(&equity_worker.lock);
+    return tally;
+}
+
+void restore_terminal() {
+    if (terminal_input) tcsetattr(STDIN_FILENO, TCSANOW, &saved_termios);
+}
+
+void interrupt_handler(int signal_number) {
+    tcsetattr(STDIN_FILENO, TCSANOW, &saved_termios);
+    _exit(128 + signal_number);
+}
+
+void enable_terminal_input() {
+    if (!isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &saved_termios) != 0) return;
+
+    struct termios raw = saved_termios;
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    if (tcsetattr(STDIN_FILENO, TCSANOW, &raw) != 0) return;
+
+    terminal_input = true;
+    start_line_editing(&player_input, saved_termios.c_cc[VERASE], saved_termios.c_cc[VKILL],
+                       saved_termios.c_cc[VEOF]);
+    atexit(restore_terminal);
+    signal(SIGINT, interrupt_handler);
+    signal(SIGTERM, interrupt_handler);
+}
+
+bool wait_for_input(int timeout_ms) {
+    fd_set read_fds;
+    FD_ZERO(&read_fds);
+    FD_SET(STDIN_FILENO, &read_fds);
+
+    struct timeval timeout = {timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+    return select(STDIN_FILENO + 1, &read_fds, NULL, NULL, &timeout) > 0;
+}
+
+void read_input() {
+    char bytes[INPUT_BUFFER_SIZE];
+    ssize_t count = read(STDIN_FILENO, bytes, sizeof(bytes));
+    if (count <= 0) {
+        player_input.closed = true;
+        return;
+    }
+
+    feed_input(&player_input, bytes, (int)count, terminal_input ? stdout : NULL);
+    if (terminal_input) fflush(stdout);
+}
+
 void print_game_state(int stage) {
     printf("\n=== TEXAS HOLD'EM POKER ===\n");
     
+    CardSet board = card_set_from_indices(community_cards, community_size);
+
     printf("Your hand: ");
-    print_card(player_hand[0]);
+    print_card(index_to_card(player_hand[0]));
     printf(" ");
-    print_card(player_hand[1]);
+    print_card(index_to_card(player_hand[1]));
     
-    HandEvaluation player_eval = evaluate_hand(player_hand, community_cards, community_size);
+    HandEvaluation player_eval = evaluate_card_set(card_set_from_indices(player_hand, HAND_SIZE) | board);
     printf(" [%s]", combination_name(player_eval.combination));
     printf("\n");
     
     if (community_size > 0) {
         printf("Community cards: ");
         for (int i = 0; i < community_size; i++) {
-            print_card(community_cards[i]);
+            print_card(index_to_card(community_cards[i]));
             printf(" ");
         }
         printf("\n");
@@ -38,40 +179,61 @@ void print_game_state(int stage) {
     const char *stage_names[] = {"Pre-flop", "Flop", "Turn", "River"};
     printf("Stage: %s\n", stage_names[stage]);
     
-    int win_prob = calculate_win_probability(player_hand, community_cards, community_size);
-    printf("Win probability: %d%%\n", win_prob);
+    if (community_size == 5) {
+        static BoardRanking ranking;
+        rank_board_holdings(board, card_set_from_indices(player_hand, HAND_SIZE), &ranking);
+        EquityTally tally = board_equity(&ranking, player_hand);
+        printf("Win probability: %d%%\n", (tally.wins * 100 + tally.ties * 50) / tally.total);
+    }
 }
 
 char get_player_action() {
-    char action;
-    printf("\nChoose action: (C)ontinue or (F)old? ");
-    scanf(" %c", &action);
+    char action = 'F';
+    int shown_samples = -1;
+
+    printf("\n");
+    while (true) {
+        EquityTally tally = equity_snapshot();
+        if (tally.total != shown_samples && input_line_empty(&player_input)) {
+            if (tally.total == 0) printf("\rWin probability: calculating...");
+            else printf("\rWin probability: %5.1f%% (%d samples)", tally_equity(tally) * 100.0, tally.total);
+            printf("  Choose action: (C)ontinue or (F)old? ");
+            fflush(stdout);
+            shown_samples = tally.total;
+        }
+
+        if (take_action(&player_input, &action) || player_input.closed) break;
+        if (wait_for_input(EQUITY_REFRESH_MS)) read_input();
+    }
+
+    stop_equity_worker();
     return action;
 }
 
-void determine_winner() {
+int determine_winner() {
     printf("\n=== FINAL HANDS ===\n");
     
-    HandEvaluation player_eval = evaluate_hand(player_hand, community_cards, 5);
-    HandEvaluation computer_eval = evaluate_hand(computer_hand, community_cards, 5);
+    CardSet board = card_set_from_indices(community_cards, 5);
+    HandEvaluation player_eval = evaluate_card_set(card_set_from_indices(player_hand, HAND_SIZE) | board);
+    HandEvaluation computer_eval = evaluate_card_set(card_set_from_indices(computer_hand, HAND_SIZE) | board);
     
     printf("Your hand: ");
-    print_card(player_hand[0]);
+    print_card(index_to_card(player_hand[0]));
     printf(" ");
-    print_card(player_hand[1]);
+    print_card(index_to_card(player_hand[1]));
     printf(" [%s]", combination_name(player_eval.combination));
     printf("\n");
     
     printf("Computer hand: ");
-    print_card(computer_hand[0]);
+    print_card(index_to_card(computer_hand[0]));
     printf(" ");
-    print_card(computer_hand[1]);
+    print_card(index_to_card(computer_hand[1]));
     printf(" [%s]", combination_name(computer_eval.combination));
     printf("\n");
     
     printf("Community cards: ");
     for (int i = 0; i < 5; i++) {
-        print_card(community_cards[i]);
+        print_card(index_to_card(community_cards[i]));
         printf(" ");
     }
     printf("\n\n");
@@ -85,11 +247,36 @@ void determine_winner() {
     } else {
         printf("🤝 IT'S A TIE! (Split pot)\n");
     }
+
+    return result;
 }
 
-int main() {
-    srand(time(NULL));
-    
+/* Every player puts one chip in; returns the bitmask of players with the best hand. */
+unsigned int showdown_winners(CardIndex hole_cards[][HAND_SIZE], int num_players, CardSet board) {
+    static const int contributions[MAX_PLAYERS] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1};
+    ShowdownResult result;
+    resolve_showdown(hole_cards, num_players, board, contributions, NULL, &result);
+    return result.winners;
+}
+
+void record_game(int flags, unsigned int winners) {
+    if (!recording) return;
+
+    HandRecord record;
+    record.flags = flags;
+    record.num_players = 2;
+    memcpy(record.hole_cards[0], player_hand, sizeof(player_hand));
+    memcpy(record.hole_cards[1], computer_hand, sizeof(computer_hand));
+    record.board_size = community_size;
+    memcpy(record.board, community_cards, community_size * sizeof(CardIndex));
+    record.winners = winners;
+
+    if (!log_hand(&game_log, &record)) fprintf(stderr, "Failed to write game log\n");
+}
+
+int play_game() {
+    enable_terminal_input();
+
     printf("TEXAS HOLD'EM POKER - LET'S HAVE FUN TODAY!\n");
     printf("Are you ready?\n");
     
@@ -103,30 +290,36 @@ int main() {
     
     community_size = 0;
     print_game_state(0);
+    start_equity_worker();
     
     char action = get_player_action();
     if (action == 'F' || action == 'f') {
         printf("You folded. Computer wins!\n");
+        record_game(HAND_FOLDED, 1u << 1);
         return 0;
     }
     
     deal_cards(deck, &current_card, community_cards, FLOP_SIZE);
     community_size = FLOP_SIZE;
     print_game_state(1);
+    start_equity_worker();
     
     action = get_player_action();
     if (action == 'F' || action == 'f') {
         printf("You folded. Computer wins!\n");
+        record_game(HAND_FOLDED, 1u << 1);
         return 0;
     }
     
     deal_cards(deck, &current_card, &community_cards[FLOP_SIZE], TURN_RIVER_SIZE);
     community_size = FLOP_SIZE + TURN_RIVER_SIZE;
     print_game_state(2);
+    start_equity_worker();
     
     action = get_player_action();
     if (action == 'F' || action == 'f') {
         printf("You folded. Computer wins!\n");
+        record_game(HAND_FOLDED, 1u << 1);
         return 0;
     }
     
@@ -134,7 +327,204 @@ int main() {
     community_size = 5;
     print_game_state(3);
     
-    determine_winner();
+    int result = determine_winner();
+    record_game(0, result > 0 ? 1u : (result < 0 ? 2u : 3u));
     
     return 0;
 }
+
+double elapsed_seconds(struct timespec start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+/* Shuffles the deck and deals two cards to each player, then board_size board
+ * cards. --simulate deals every hand this way and play_game() deals in the same
+ * order from its single shuffle, so a session's seed reproduces its hands. */
+void deal_hand(CardIndex hole_cards[][HAND_SIZE], int num_players, CardIndex *board, int board_size) {
+    int current_card = 0;
+
+    shuffle_deck();
+    for (int player = 0; player < num_players; player++) {
+        deal_cards(deck, &current_card, hole_cards[player], HAND_SIZE);
+    }
+    deal_cards(deck, &current_card, board, board_size);
+}
+
+/* Hands dealt from the seeded deck straight to a num_players-way showdown. */
+int run_simulation(long num_hands, int num_players) {
+    CardIndex hole_cards[MAX_PLAYERS][HAND_SIZE];
+    CardIndex board[5];
+    long wins[MAX_PLAYERS] = {0};
+    long split_pots = 0;
+
+    initialize_deck();
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (long hand = 0; hand < num_hands; hand++) {
+        deal_hand(hole_cards, num_players, board, 5);
+
+        unsigned int winners = showdown_winners(hole_cards, num_players, card_set_from_indices(board, 5));
+        if (winners & (winners - 1)) {
+            split_pots++;
+        } else {
+            for (int player = 0; player < num_players; player++) {
+                if (winners == (1u << player)) wins[player]++;
+            }
+        }
+
+        if (recording) {
+            HandRecord record;
+            record.flags = 0;
+            record.num_players = num_players;
+            memcpy(record.hole_cards, hole_cards, num_players * sizeof(hole_cards[0]));
+            record.board_size = 5;
+            memcpy(record.board, board, sizeof(board));
+            record.winners = winners;
+            if (!log_hand(&game_log, &record)) {
+                fprintf(stderr, "Failed to write game log\n");
+                return 1;
+            }
+        }
+    }
+
+    double elapsed = elapsed_seconds(start);
+    printf("Simulated %ld %d-player hands in %.3f s (%.0f hands/s)\n",
+           num_hands, num_players, elapsed, num_hands / elapsed);
+    for (int player = 0; player < num_players; player++) {
+        printf("Player %d wins: %ld\n", player + 1, wins[player]);
+    }
+    printf("Split pots: %ld\n", split_pots);
+    return 0;
+}
+
+/* Deals the session's next hand again and compares it with the logged cards. */
+bool deal_matches(const HandRecord *record) {
+    CardIndex hole_cards[MAX_PLAYERS][HAND_SIZE];
+    CardIndex board[5];
+
+    deal_hand(hole_cards, record->num_players, board, record->board_size);
+    return memcmp(hole_cards, record->hole_cards, record->num_players * sizeof(hole_cards[0])) == 0 &&
+           memcmp(board, record->board, record->board_size * sizeof(CardIndex)) == 0;
+}
+
+/* Re-deals every logged hand from its session's seed and re-runs every showdown
+ * through the evaluator, checking the recorded cards and winners. */
+int run_replay(const char *path) {
+    GameLog reader;
+    if (!open_log_reader(&reader, path)) {
+        fprintf(stderr, "Cannot open log %s\n", path);
+        return 2;
+    }
+
+    HandRecord record;
+    uint32_t seed = 0;
+    long sessions = 0, hands = 0, showdowns = 0, deal_mismatches = 0, mismatches = 0;
+    LogRecordType type;
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    while ((type = read_log_record(&reader, &seed, &record)) != LOG_RECORD_END) {
+        if (type == LOG_RECORD_ERROR) {
+            fprintf(stderr, "Corrupt log record after %ld hands\n", hands);
+            close_game_log(&reader);
+            return 2;
+        }
+        if (type == LOG_RECORD_SESSION) {
+            sessions++;
+            srand(seed);
+            initialize_deck();
+            continue;
+        }
+
+        hands++;
+        if (sessions == 0 || !deal_matches(&record)) {
+            if (deal_mismatches == 0) {
+                printf("First deal mismatch in hand %ld (seed %u): logged cards differ from the seeded deal\n",
+                       hands, seed);
+            }
+            deal_mismatches++;
+        }
+
+        if ((record.flags & HAND_FOLDED) || record.board_size < 5) continue;
+
+        showdowns++;
+        unsigned int winners = showdown_winners(record.hole_cards, record.num_players,
+                                                card_set_from_indices(record.board, 5));
+        if (winners != record.winners) {
+            if (mismatches == 0) {
+                printf("First winners mismatch in hand %ld (seed %u): recorded 0x%x, replayed 0x%x\n",
+                       hands, seed, record.winners, winners);
+            }
+            mismatches++;
+        }
+    }
+    close_game_log(&reader);
+
+    double elapsed = elapsed_seconds(start);
+    printf("Replayed %ld session(s), %ld hands, %ld showdowns in %.3f s\n", sessions, hands, showdowns, elapsed);
+    bool ok = (deal_mismatches == 0 && mismatches == 0);
+    printf("%s: %ld deal mismatch(es), %ld winners mismatch(es)\n", ok ? "REPLAY OK" : "REPLAY FAILED",
+           deal_mismatches, mismatches);
+    return ok ? 0 : 1;
+}
+
+void print_usage(const char *program) {
+    fprintf(stderr, "Usage: %s [--seed N] [--record FILE] [--simulate HANDS [--players 2-%d]]\n",
+            program, MAX_PLAYERS);
+    fprintf(stderr, "       %s --replay FILE\n", program);
+}
+
+int main(int argc, char **argv) {
+    uint32_t seed = (uint32_t)time(NULL);
+    const char *record_path = NULL;
+    const char *replay_path = NULL;
+    long simulate_hands = 0;
+    int num_players = 2;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay_path = argv[++i];
+        } else if (strcmp(argv[i], "--simulate") == 0 && i + 1 < argc) {
+            simulate_hands = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--players") == 0 && i + 1 < argc) {
+            num_players = atoi(argv[++i]);
+        } else {
+            print_usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (num_players < 2 || num_players > MAX_PLAYERS) {
+        print_usage(argv[0]);
+        return 2;
+    }
+
+    if (replay_path != NULL) return run_replay(replay_path);
+
+    srand(seed);
+
+    if (record_path != NULL) {
+        if (!open_game_log(&game_log, record_path, seed)) {
+            fprintf(stderr, "Cannot open log %s\n", record_path);
+            return 2;
+        }
+        recording = true;
+    }
+
+    int status = (simulate_hands > 0) ? run_simulation(simulate_hands, num_players) : play_game();
+
+    if (recording && !close_game_log(&game_log)) {
+        fprintf(stderr, "Failed to write game log\n");
+        status = 1;
+    }
+    return status;
+}
@@ -4,6 +4,8 @@
 
 extern "C" {
     #include "poker.h"
+    #include "poker_log.h"
+    #include "poker_input.h"
 }
 
 class PokerTest : public ::testing::Test {
@@ -17,10 +19,19 @@ protected:
         return (card1.rank == card2.rank && card1.suit == card2.suit);
     }
 
+    void feed(InputBuffer *input, const char *text, FILE *echo = NULL) {
+        feed_input(input, text, (int)strlen(text), echo);
+    }
+
+    CardIndex card(int rank, int suit) {
+        Card value = {rank, suit};
+        return card_to_index(value);
+    }
+
     bool is_deck_unique() {
         for (int i = 0; i < NUM_CARDS; i++) {
             for (int j = i + 1; j < NUM_CARDS; j++) {
-                if (cards_equal(deck[i], deck[j])) {
+                if (deck[i] == deck[j]) {
                     return false;
                 }
             }
@@ -36,25 +47,27 @@ TEST_F(PokerTest, DeckInitializationCreatesUniqueCards) {
 TEST_F(PokerTest, DealCardsProvidesCorrectNumberOfCards) {
     shuffle_deck();
     int current_card = 0;
-    Card test_hand1[HAND_SIZE];
-    Card test_hand2[HAND_SIZE];
+    CardIndex test_hand1[HAND_SIZE];
+    CardIndex test_hand2[HAND_SIZE];
     
     deal_cards(deck, &current_card, test_hand1, HAND_SIZE);
     deal_cards(deck, &current_card, test_hand2, HAND_SIZE);
     
+    EXPECT_EQ(current_card, 2 * HAND_SIZE) << "Повинно бути роздано чотири карти";
     for (int i = 0; i < HAND_SIZE; i++) {
-        EXPECT_GE(test_hand1[i].rank, 2) << "Ранг карти повинен бути >= 2";
-        EXPECT_LE(test_hand1[i].rank, 14) << "Ранг карти повинен бути <= 14";
-        EXPECT_GE(test_hand1[i].suit, 0) << "Масть карти повинна бути >= 0";
-        EXPECT_LE(test_hand1[i].suit, 3) << "Масть карти повинна бути <= 3";
+        Card dealt = index_to_card(test_hand1[i]);
+        EXPECT_GE(dealt.rank, 2) << "Ранг карти повинен бути >= 2";
+        EXPECT_LE(dealt.rank, 14) << "Ранг карти повинен бути <= 14";
+        EXPECT_GE(dealt.suit, 0) << "Масть карти повинна бути >= 0";
+        EXPECT_LE(dealt.suit, 3) << "Масть карти повинна бути <= 3";
     }
 }
 
 TEST_F(PokerTest, PlayersReceiveDifferentCards) {
     shuffle_deck();
     int current_card = 0;
-    Card player_hand[HAND_SIZE];
-    Card computer_hand[HAND_SIZE];
+    CardIndex player_hand[HAND_SIZE];
+    CardIndex computer_hand[HAND_SIZE];
     
     deal_cards(deck, &current_card, player_hand, HAND_SIZE);
     deal_cards(deck, &current_card, computer_hand, HAND_SIZE);
@@ -62,7 +75,7 @@ TEST_F(PokerTest, PlayersReceiveDifferentCards) {
     bool cards_are_different = true;
     for (int i = 0; i < HAND_SIZE; i++) {
         for (int j = 0; j < HAND_SIZE; j++) {
-            if (cards_equal(player_hand[i], computer_hand[j])) {
+            if (player_hand[i] == computer_hand[j]) {
                 cards_are_different = false;
             }
         }
@@ -240,6 +253,326 @@ TEST_F(PokerTest, CombinationNamesAreCorrect) {
     EXPECT_STREQ(combination_name(ROYAL_FLUSH), "Royal Flush");
 }
 
+TEST_F(PokerTest, CardIndexRoundTripsAllCards) {
+    for (int suit = 0; suit < NUM_SUITS; suit++) {
+        for (int rank = 2; rank <= 14; rank++) {
+            Card original = {rank, suit};
+            CardIndex index = card_to_index(original);
+            EXPECT_EQ(index, suit * NUM_RANKS + rank - 2) << "Індекс повинен відповідати порядку initialize_deck";
+            EXPECT_TRUE(cards_equal(index_to_card(index), original)) << "Карта повинна відновлюватися з індексу";
+            EXPECT_EQ(deck[index], index);
+        }
+    }
+}
+
+TEST_F(PokerTest, CardSetToIndicesListsCardsInOrder) {
+    Card cards[4] = {{7, 3}, {14, 0}, {5, 0}, {2, 1}};
+    CardIndex indices[NUM_CARDS];
+
+    int count = card_set_to_indices(card_set_from_cards(cards, 4), indices);
+
+    ASSERT_EQ(count, 4) << "Кожна карта повинна з'явитися один раз";
+    EXPECT_EQ(indices[0], card(5, 0)) << "Індекси повинні йти за зростанням";
+    EXPECT_EQ(indices[1], card(14, 0));
+    EXPECT_EQ(indices[2], card(2, 1));
+    EXPECT_EQ(indices[3], card(7, 3));
+
+    EXPECT_EQ(card_set_to_indices(FULL_DECK_SET, indices), NUM_CARDS);
+    for (int i = 0; i < NUM_CARDS; i++) {
+        EXPECT_EQ(indices[i], i) << "Повна колода повинна дати індекси 0..51";
+    }
+    EXPECT_EQ(card_set_to_indices(EMPTY_CARD_SET, indices), 0);
+}
+
+TEST_F(PokerTest, CardSetSizeCountsCards) {
+    Card cards[3] = {{14, 0}, {14, 0}, {9, 2}};
+
+    EXPECT_EQ(card_set_size(EMPTY_CARD_SET), 0);
+    EXPECT_EQ(card_set_size(FULL_DECK_SET), NUM_CARDS) << "Повна колода містить 52 карти";
+    EXPECT_EQ(card_set_size(card_set_from_cards(cards, 3)), 2) << "Однакові карти рахуються один раз";
+    EXPECT_EQ(card_set_size(card_set_from_indices(deck, 7)), 7);
+}
+
+TEST_F(PokerTest, EvaluateCardSetFindsAceLowStraightAndStraightFlush) {
+    Card wheel[7] = {{14, 0}, {2, 1}, {3, 2}, {4, 3}, {5, 0}, {9, 1}, {13, 2}};
+    Card straight_flush[7] = {{5, 1}, {6, 1}, {7, 1}, {8, 1}, {9, 1}, {9, 0}, {14, 1}};
+    Card steel_wheel[7] = {{14, 2}, {2, 2}, {3, 2}, {4, 2}, {5, 2}, {13, 2}, {13, 0}};
+
+    HandEvaluation eval = evaluate_card_set(card_set_from_cards(wheel, 7));
+    EXPECT_EQ(eval.combination, STRAIGHT) << "A-2-3-4-5 - це стріт";
+    EXPECT_EQ(eval.highest_card, 5) << "Старша карта стріту від туза - п'ятірка";
+
+    eval = evaluate_card_set(card_set_from_cards(straight_flush, 7));
+    EXPECT_EQ(eval.combination, STRAIGHT_FLUSH) << "Повинен бути виявлений стрейт-флеш";
+    EXPECT_EQ(eval.highest_card, 9);
+
+    eval = evaluate_card_set(card_set_from_cards(steel_wheel, 7));
+    EXPECT_EQ(eval.combination, STRAIGHT_FLUSH) << "A-2-3-4-5 однієї масті - стрейт-флеш, а не флеш";
+    EXPECT_EQ(eval.highest_card, 5);
+}
+
+TEST_F(PokerTest, EvaluateWithBoardMatchesEvaluateHand) {
+    Card board[5] = {{10, 2}, {9, 3}, {5, 0}, {5, 1}, {2, 2}};
+    Card hands[4][HAND_SIZE] = {{{10, 0}, {9, 1}}, {{5, 2}, {5, 3}}, {{14, 2}, {13, 2}}, {{3, 0}, {4, 1}}};
+    BoardAnalysis analysis;
+    analyze_board(card_set_from_cards(board, 5), &analysis);
+
+    for (int i = 0; i < 4; i++) {
+        HandEvaluation expected = evaluate_hand(hands[i], board, 5);
+        HandEvaluation actual = evaluate_with_board(&analysis, card_set_from_cards(hands[i], HAND_SIZE));
+        EXPECT_EQ(compare_evaluations(expected, actual), 0) << "Оцінка з аналізом борду повинна збігатися з evaluate_hand";
+    }
+}
+
+TEST_F(PokerTest, BoardRankingIsSortedAndExcludesDeadCards) {
+    static BoardRanking ranking;
+    Card board[5] = {{14, 0}, {13, 0}, {7, 1}, {7, 2}, {2, 3}};
+    Card hero[HAND_SIZE] = {{12, 0}, {11, 0}};
+    Card sevens[HAND_SIZE] = {{7, 0}, {7, 3}};
+    CardSet board_set = card_set_from_cards(board, 5);
+
+    EXPECT_EQ(rank_board_holdings(board_set, EMPTY_CARD_SET, &ranking), 1081) << "На борді з 5 карт повинно бути 1081 можливих рук";
+    EXPECT_EQ(rank_board_holdings(board_set, card_set_from_cards(hero, HAND_SIZE), &ranking), 990) << "Мертві карти повинні виключатися";
+
+    for (int i = 1; i < ranking.count; i++) {
+        EXPECT_LE(ranking.holdings[i - 1].score, ranking.holdings[i].score) << "Руки повинні бути відсортовані за силою";
+    }
+    const RankedHolding &best = ranking.holdings[ranking.count - 1];
+    EXPECT_EQ(best.score, evaluation_score(evaluate_hand(sevens, board, 5))) << "Найсильніша рука - каре сімок";
+    EXPECT_EQ(best.hole[0], card(7, 0));
+    EXPECT_EQ(best.hole[1], card(7, 3));
+}
+
+TEST_F(PokerTest, BoardEquityMatchesBruteForce) {
+    static BoardRanking ranking;
+    Card board[5] = {{10, 2}, {9, 3}, {5, 0}, {3, 1}, {2, 2}};
+    Card hero[HAND_SIZE] = {{10, 0}, {8, 1}};
+    CardIndex hero_cards[HAND_SIZE] = {card(10, 0), card(8, 1)};
+    rank_board_holdings(card_set_from_cards(board, 5), EMPTY_CARD_SET, &ranking);
+
+    EquityTally expected = {0, 0, 0};
+    HandEvaluation hero_eval = evaluate_hand(hero, board, 5);
+    for (int i = 0; i < ranking.count; i++) {
+        Card hole[HAND_SIZE] = {index_to_card(ranking.holdings[i].hole[0]), index_to_card(ranking.holdings[i].hole[1])};
+        if (cards_equal(hole[0], hero[0]) || cards_equal(hole[0], hero[1]) ||
+            cards_equal(hole[1], hero[0]) || cards_equal(hole[1], hero[1])) continue;
+        int result = compare_evaluations(hero_eval, evaluate_hand(hole, board, 5));
+        if (result > 0) expected.wins++;
+        else if (result == 0) expected.ties++;
+        expected.total++;
+    }
+
+    EquityTally tally = board_equity(&ranking, hero_cards);
+    EXPECT_EQ(tally.total, 990) << "Руки з картами героя не повинні враховуватися";
+    EXPECT_EQ(tally.wins, expected.wins);
+    EXPECT_EQ(tally.ties, expected.ties);
+
+    CardIndex range[2 * HAND_SIZE] = {card(9, 0), card(9, 1), card(4, 0), card(4, 1)};
+    EquityTally range_tally = board_range_equity(&ranking, hero_cards, range, 2);
+    EXPECT_EQ(range_tally.total, 2);
+    EXPECT_EQ(range_tally.wins, 1) << "Пара десяток перемагає 44, але програє сету дев'яток";
+    EXPECT_DOUBLE_EQ(tally_equity(range_tally), 0.5);
+}
+
+TEST_F(PokerTest, SimulateEquityAccumulatesDeterministically) {
+    CardIndex hand[HAND_SIZE] = {card(14, 0), card(14, 1)};
+    uint32_t seed1 = 1234, seed2 = 1234;
+    EquityTally first = {0, 0, 0};
+    EquityTally second = {0, 0, 0};
+
+    simulate_equity(hand, EMPTY_CARD_SET, 500, &seed1, &first);
+    simulate_equity(hand, EMPTY_CARD_SET, 500, &seed1, &first);
+    simulate_equity(hand, EMPTY_CARD_SET, 500, &seed2, &second);
+    simulate_equity(hand, EMPTY_CARD_SET, 500, &seed2, &second);
+
+    EXPECT_EQ(first.total, 1000) << "Результати пакетів повинні накопичуватися";
+    EXPECT_EQ(first.wins, second.wins) << "Однаковий seed повинен давати однаковий результат";
+    EXPECT_EQ(first.ties, second.ties);
+    EXPECT_GT(tally_equity(first), 0.7) << "Пара тузів повинна мати високу ймовірність виграшу";
+}
+
+TEST_F(PokerTest, ShowdownSplitsPotWithOddChip) {
+    CardIndex hole_cards[3][HAND_SIZE] = {{card(14, 0), card(3, 1)}, {card(14, 1), card(3, 2)}, {card(9, 3), card(4, 0)}};
+    Card board[5] = {{14, 2}, {13, 3}, {12, 0}, {7, 1}, {2, 2}};
+    int contributions[3] = {11, 11, 11};
+    ShowdownResult result;
+
+    resolve_showdown(hole_cards, 3, card_set_from_cards(board, 5), contributions, NULL, &result);
+
+    EXPECT_EQ(result.winners, 3u) << "Дві однакові пари тузів ділять банк";
+    EXPECT_EQ(result.payout[0], 17) << "Непарна фішка дістається першому місцю";
+    EXPECT_EQ(result.payout[1], 16);
+    EXPECT_EQ(result.payout[2], 0);
+}
+
+TEST_F(PokerTest, ShowdownPaysMainAndSidePots) {
+    CardIndex hole_cards[4][HAND_SIZE] = {{card(14, 0), card(14, 1)}, {card(13, 0), card(13, 1)},
+                                          {card(12, 0), card(12, 1)}, {card(11, 0), card(11, 1)}};
+    Card board[5] = {{2, 2}, {5, 3}, {8, 2}, {9, 3}, {4, 2}};
+    int contributions[4] = {20, 50, 100, 100};
+    bool folded[4] = {false, false, false, true};
+    ShowdownResult result;
+
+    resolve_showdown(hole_cards, 4, card_set_from_cards(board, 5), contributions, folded, &result);
+
+    EXPECT_EQ(result.winners, 1u) << "Пара тузів - найкраща рука";
+    EXPECT_EQ(result.score[3], -1) << "Гравець, що скинув карти, не оцінюється";
+    EXPECT_EQ(result.payout[0], 80) << "Короткий стек виграє лише основний банк";
+    EXPECT_EQ(result.payout[1], 90) << "Пара королів виграє перший побічний банк";
+    EXPECT_EQ(result.payout[2], 100) << "Пара дам виграє другий побічний банк";
+    EXPECT_EQ(result.payout[3], 0);
+}
+
+TEST_F(PokerTest, ShowdownReturnsUnclaimedChips) {
+    CardIndex hole_cards[2][HAND_SIZE] = {{card(14, 0), card(14, 1)}, {card(13, 0), card(13, 1)}};
+    Card board[5] = {{2, 2}, {5, 3}, {8, 2}, {9, 3}, {4, 2}};
+    int contributions[2] = {30, 50};
+    bool folded[2] = {false, true};
+    ShowdownResult result;
+
+    resolve_showdown(hole_cards, 2, card_set_from_cards(board, 5), contributions, folded, &result);
+
+    EXPECT_EQ(result.payout[0], 60) << "Гравець виграє лише те, що покрив";
+    EXPECT_EQ(result.payout[1], 20) << "Неоплачена ставка повертається";
+}
+
+TEST_F(PokerTest, ShowdownRejectsTooManyPlayers) {
+    CardIndex hole_cards[MAX_PLAYERS + 1][HAND_SIZE];
+    int contributions[MAX_PLAYERS + 1];
+    for (int i = 0; i <= MAX_PLAYERS; i++) {
+        hole_cards[i][0] = deck[2 * i];
+        hole_cards[i][1] = deck[2 * i + 1];
+        contributions[i] = 10;
+    }
+    CardSet board = card_set_from_indices(&deck[40], 5);
+    ShowdownResult result;
+
+    EXPECT_FALSE(resolve_showdown(hole_cards, MAX_PLAYERS + 1, board, contributions, NULL, &result))
+        << "Більше ніж MAX_PLAYERS гравців повинно відхилятися";
+    EXPECT_EQ(result.num_players, 0);
+    EXPECT_EQ(result.winners, 0u);
+    EXPECT_FALSE(resolve_showdown(hole_cards, 0, board, contributions, NULL, &result));
+    EXPECT_TRUE(resolve_showdown(hole_cards, MAX_PLAYERS, board, contributions, NULL, &result));
+    EXPECT_EQ(result.num_players, MAX_PLAYERS);
+}
+
+TEST_F(PokerTest, GameLogRoundTripsSessionsAndHands) {
+    const char *path = "poker_log_test.bin";
+    remove(path);
+
+    HandRecord showdown = {0, 2, {{card(14, 0), card(13, 1)}, {card(2, 2), card(7, 3)}}, 5,
+                           {card(10, 0), card(9, 1), card(5, 2), card(3, 3), card(2, 0)}, 1u};
+    HandRecord folded = {HAND_FOLDED, 2, {{card(4, 0), card(8, 1)}, {card(12, 2), card(12, 3)}}, 3,
+                         {card(6, 0), card(11, 1), card(14, 3)}, 2u};
+
+    GameLog log;
+    ASSERT_TRUE(open_game_log(&log, path, 123456789u));
+    EXPECT_TRUE(log_hand(&log, &showdown));
+    close_game_log(&log);
+    ASSERT_TRUE(open_game_log(&log, path, 42u)) << "Лог повинен дописуватися в кінець файлу";
+    EXPECT_TRUE(log_hand(&log, &folded));
+    close_game_log(&log);
+
+    GameLog reader;
+    HandRecord record;
+    uint32_t seed = 0;
+    ASSERT_TRUE(open_log_reader(&reader, path));
+
+    EXPECT_EQ(read_log_record(&reader, &seed, &record), LOG_RECORD_SESSION);
+    EXPECT_EQ(seed, 123456789u);
+    ASSERT_EQ(read_log_record(&reader, &seed, &record), LOG_RECORD_HAND);
+    EXPECT_EQ(record.num_players, 2);
+    EXPECT_EQ(record.board_size, 5);
+    EXPECT_EQ(record.winners, 1u);
+    EXPECT_EQ(record.hole_cards[1][1], showdown.hole_cards[1][1]);
+    EXPECT_EQ(record.board[4], showdown.board[4]);
+
+    EXPECT_EQ(read_log_record(&reader, &seed, &record), LOG_RECORD_SESSION);
+    EXPECT_EQ(seed, 42u);
+    ASSERT_EQ(read_log_record(&reader, &seed, &record), LOG_RECORD_HAND);
+    EXPECT_EQ(record.flags, HAND_FOLDED);
+    EXPECT_EQ(record.board_size, 3);
+    EXPECT_EQ(record.board[2], folded.board[2]);
+
+    EXPECT_EQ(read_log_record(&reader, &seed, &record), LOG_RECORD_END);
+    close_game_log(&reader);
+    remove(path);
+}
+
+TEST_F(PokerTest, TakeActionReadsLikeScanf) {
+    InputBuffer input = {};
+    char action = 0;
+
+    feed(&input, "c c\n");
+    ASSERT_TRUE(take_action(&input, &action));
+    EXPECT_EQ(action, 'c');
+    ASSERT_TRUE(take_action(&input, &action)) << "Дві відповіді в одному рядку читаються по черзі";
+    EXPECT_EQ(action, 'c');
+    EXPECT_FALSE(take_action(&input, &action));
+
+    feed(&input, "\n  \n\t\nf\n");
+    ASSERT_TRUE(take_action(&input, &action)) << "Порожні рядки пропускаються";
+    EXPECT_EQ(action, 'f');
+    EXPECT_TRUE(input_line_empty(&input));
+}
+
+TEST_F(PokerTest, TakeActionWaitsForCompleteLine) {
+    InputBuffer input = {};
+    char action = 0;
+
+    EXPECT_TRUE(input_line_empty(&input));
+    feed(&input, "c");
+    EXPECT_FALSE(input_line_empty(&input)) << "Гравець почав вводити рядок";
+    EXPECT_FALSE(take_action(&input, &action)) << "Незавершений рядок ще не є відповіддю";
+
+    feed(&input, "\r");
+    EXPECT_TRUE(input_line_empty(&input));
+    ASSERT_TRUE(take_action(&input, &action));
+    EXPECT_EQ(action, 'c');
+
+    feed(&input, "f");
+    input.closed = true;
+    ASSERT_TRUE(take_action(&input, &action)) << "Останній рядок без переводу читається після кінця вводу";
+    EXPECT_EQ(action, 'f');
+    EXPECT_FALSE(take_action(&input, &action));
+}
+
+TEST_F(PokerTest, LineEditingHandlesControlCharacters) {
+    InputBuffer input = {};
+    char action = 0;
+    start_line_editing(&input, 0x7F, 0x15, 0x04);
+
+    feed(&input, "x\x7F");
+    EXPECT_TRUE(input_line_empty(&input)) << "Backspace стирає символ";
+    feed(&input, "abc\x15");
+    EXPECT_TRUE(input_line_empty(&input)) << "Ctrl-U стирає рядок";
+    feed(&input, "\x1b[A\x1bOB\x1b[1;5C\x07");
+    EXPECT_TRUE(input_line_empty(&input)) << "Стрілки та інші керуючі символи відкидаються";
+
+    feed(&input, "f\n");
+    ASSERT_TRUE(take_action(&input, &action));
+    EXPECT_EQ(action, 'f');
+
+    feed(&input, "\x04" "c\n");
+    EXPECT_TRUE(input.closed) << "Ctrl-D завершує ввід";
+    EXPECT_FALSE(take_action(&input, &action)) << "Символи після Ctrl-D ігноруються";
+}
+
+TEST_F(PokerTest, LineEditingEchoesAcceptedInput) {
+    InputBuffer input = {};
+    start_line_editing(&input, 0x7F, 0x15, 0x04);
+    FILE *echo = tmpfile();
+    ASSERT_NE(echo, nullptr);
+
+    feed(&input, "\x1b[Dcx\x7F\n", echo);
+
+    char written[16] = {0};
+    rewind(echo);
+    size_t size = fread(written, 1, sizeof(written) - 1, echo);
+    fclose(echo);
+    EXPECT_EQ(std::string(written, size), "cx\b \b\n") << "Відлунюються лише прийняті символи";
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
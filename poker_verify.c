@@ -0,0 +1,420 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "poker.h"
+#include <pthread.h>
+#include <unistd.h>
+
+#define NUM_SEVEN_CARD_HANDS 133784560LL
+#define NUM_COMBINATIONS (ROYAL_FLUSH + 1)
+#define MAX_THREADS 64
+
+typedef HandEvaluation (*HandEvaluator)(Card *hand, Card *community_cards, int community_size);
+
+typedef struct {
+    const char *name;
+    HandEvaluator evaluate;
+} Candidate;
+
+/* Descending by rank like the original qsort comparator; an insertion sort on
+ * seven cards avoids the qsort call that dominated the exhaustive run. */
+static void reference_sort_cards(Card *cards, int num_cards) {
+    for (int i = 1; i < num_cards; i++) {
+        Card card = cards[i];
+        int j = i - 1;
+        while (j >= 0 && cards[j].rank < card.rank) {
+            cards[j + 1] = cards[j];
+            j--;
+        }
+        cards[j + 1] = card;
+    }
+}
+
+static int reference_straight_high(Card *cards, int num_cards) {
+    int ranks[15] = {0};
+    
+    for (int i = 0; i < num_cards; i++) {
+        ranks[cards[i].rank] = 1;
+        if (cards[i].rank == 14) ranks[1] = 1;
+    }
+    
+    for (int i = 14; i >= 5; i--) {
+        if (ranks[i] && ranks[i-1] && ranks[i-2] && ranks[i-3] && ranks[i-4]) {
+            return i;
+        }
+    }
+    
+    if (ranks[14] && ranks[2] && ranks[3] && ranks[4] && ranks[5]) {
+        return 5;
+    }
+    
+    return -1;
+}
+
+static bool reference_straight_flush(Card *cards, int num_cards, int flush_suit, int *high_card) {
+    Card suited_cards[num_cards];
+    int suited_count = 0;
+    
+    for (int i = 0; i < num_cards; i++) {
+        if (cards[i].suit == flush_suit) {
+            suited_cards[suited_count++] = cards[i];
+        }
+    }
+    
+    if (suited_count < 5) return false;
+    
+    *high_card = reference_straight_high(suited_cards, suited_count);
+    return (*high_card != -1);
+}
+
+/* The original sort-based evaluator, kept as the oracle that every library
+ * evaluator is checked against. */
+static HandEvaluation reference_evaluate_hand(Card *hand, Card *community_cards, int community_size) {
+    Card all_cards[7];
+    HandEvaluation eval = {HIGH_CARD, 0, 0, 0, 0, 0};
+    
+    int total_cards = 0;
+    for (int i = 0; i < HAND_SIZE; i++) all_cards[total_cards++] = hand[i];
+    for (int i = 0; i < community_size; i++) all_cards[total_cards++] = community_cards[i];
+    
+    reference_sort_cards(all_cards, total_cards);
+    
+    int rank_count[15] = {0};
+    int suit_count[4] = {0};
+    
+    for (int i = 0; i < total_cards; i++) {
+        rank_count[all_cards[i].rank]++;
+        suit_count[all_cards[i].suit]++;
+    }
+    
+    int flush_suit = -1;
+    for (int suit = 0; suit < 4; suit++) {
+        if (suit_count[suit] >= 5) {
+            flush_suit = suit;
+            break;
+        }
+    }
+    
+    int straight_high = reference_straight_high(all_cards, total_cards);
+    
+    if (flush_suit != -1 && straight_high != -1) {
+        if (reference_straight_flush(all_cards, total_cards, flush_suit, &straight_high)) {
+            eval.combination = (straight_high == 14) ? ROYAL_FLUSH : STRAIGHT_FLUSH;
+            eval.highest_card = straight_high;
+            return eval;
+        }
+    }
+    
+    for (int rank = 14; rank >= 2; rank--) {
+        if (rank_count[rank] == 4) {
+            eval.combination = FOUR_OF_A_KIND;
+            eval.highest_card = rank;
+            for (int i = 0; i < total_cards; i++) {
+                if (all_cards[i].rank != rank) {
+                    eval.second_highest_card = all_cards[i].rank;
+                    break;
+                }
+            }
+            return eval;
+        }
+    }
+    
+    int three_rank = -1, two_rank = -1;
+    for (int rank = 14; rank >= 2; rank--) {
+        if (rank_count[rank] == 3) {
+            if (three_rank == -1) three_rank = rank;
+            else if (two_rank == -1) two_rank = rank;
+        } else if (rank_count[rank] == 2) {
+            if (two_rank == -1) two_rank = rank;
+        }
+    }
+    if (three_rank != -1 && two_rank != -1) {
+        eval.combination = FULL_HOUSE;
+        eval.highest_card = three_rank;
+        eval.second_highest_card = two_rank;
+        return eval;
+    }
+    
+    if (flush_suit != -1) {
+        eval.combination = FLUSH;
+        int flush_cards = 0;
+        for (int i = 0; i < total_cards && flush_cards < 5; i++) {
+            if (all_cards[i].suit == flush_suit) {
+                switch(flush_cards) {
+                    case 0: eval.highest_card = all_cards[i].rank; break;
+                    case 1: eval.second_highest_card = all_cards[i].rank; break;
+                    case 2: eval.third_highest_card = all_cards[i].rank; break;
+                    case 3: eval.fourth_highest_card = all_cards[i].rank; break;
+                    case 4: eval.fifth_highest_card = all_cards[i].rank; break;
+                }
+                flush_cards++;
+            }
+        }
+        return eval;
+    }
+    
+    if (straight_high != -1) {
+        eval.combination = STRAIGHT;
+        eval.highest_card = straight_high;
+        return eval;
+    }
+    
+    for (int rank = 14; rank >= 2; rank--) {
+        if (rank_count[rank] == 3) {
+            eval.combination = THREE_OF_A_KIND;
+            eval.highest_card = rank;
+            int kickers = 0;
+            for (int i = 0; i < total_cards && kickers < 2; i++) {
+                if (all_cards[i].rank != rank) {
+                    if (kickers == 0) eval.second_highest_card = all_cards[i].rank;
+                    else eval.third_highest_card = all_cards[i].rank;
+                    kickers++;
+                }
+            }
+            return eval;
+        }
+    }
+    
+    int pairs[2] = {-1, -1};
+    for (int rank = 14; rank >= 2; rank--) {
+        if (rank_count[rank] == 2) {
+            if (pairs[0] == -1) pairs[0] = rank;
+            else if (pairs[1] == -1) pairs[1] = rank;
+        }
+    }
+    if (pairs[0] != -1 && pairs[1] != -1) {
+        eval.combination = TWO_PAIR;
+        eval.highest_card = pairs[0];
+        eval.second_highest_card = pairs[1];
+        for (int i = 0; i < total_cards; i++) {
+            if (all_cards[i].rank != pairs[0] && all_cards[i].rank != pairs[1]) {
+                eval.third_highest_card = all_cards[i].rank;
+                break;
+            }
+        }
+        return eval;
+    }
+    
+    for (int rank = 14; rank >= 2; rank--) {
+        if (rank_count[rank] == 2) {
+            eval.combination = PAIR;
+            eval.highest_card = rank;
+            int kickers = 0;
+            for (int i = 0; i < total_cards && kickers < 3; i++) {
+                if (all_cards[i].rank != rank) {
+                    switch(kickers) {
+                        case 0: eval.second_highest_card = all_cards[i].rank; break;
+                        case 1: eval.third_highest_card = all_cards[i].rank; break;
+                        case 2: eval.fourth_highest_card = all_cards[i].rank; break;
+                    }
+                    kickers++;
+                }
+            }
+            return eval;
+        }
+    }
+    
+    eval.combination = HIGH_CARD;
+    eval.highest_card = all_cards[0].rank;
+    eval.second_highest_card = all_cards[1].rank;
+    eval.third_highest_card = all_cards[2].rank;
+    eval.fourth_highest_card = all_cards[3].rank;
+    eval.fifth_highest_card = all_cards[4].rank;
+    
+    return eval;
+}
+
+static HandEvaluation evaluate_shared_board(Card *hand, Card *community_cards, int community_size) {
+    BoardAnalysis analysis;
+    analyze_board(card_set_from_cards(community_cards, community_size), &analysis);
+    return evaluate_with_board(&analysis, card_set_from_cards(hand, HAND_SIZE));
+}
+
+/* Evaluators checked against reference_evaluate_hand on every 7-card hand.
+ * Register new fast evaluators here before the {NULL, NULL} terminator. */
+static const Candidate candidates[] = {
+    {"evaluate_hand", evaluate_hand},
+    {"evaluate_with_board", evaluate_shared_board},
+    {NULL, NULL}
+};
+
+/* Known 7-card frequencies; STRAIGHT_FLUSH excludes the royal flushes. */
+static const long long reference_counts[NUM_COMBINATIONS] = {
+    23294460LL,  /* HIGH_CARD */
+    58627800LL,  /* PAIR */
+    31433400LL,  /* TWO_PAIR */
+    6461620LL,   /* THREE_OF_A_KIND */
+    6180020LL,   /* STRAIGHT */
+    4047644LL,   /* FLUSH */
+    3473184LL,   /* FULL_HOUSE */
+    224848LL,    /* FOUR_OF_A_KIND */
+    37260LL,     /* STRAIGHT_FLUSH */
+    4324LL       /* ROYAL_FLUSH */
+};
+
+typedef struct {
+    long long counts[NUM_COMBINATIONS];
+    long long mismatches;
+    int first_mismatch_candidate;
+    Card first_mismatch_cards[7];
+} WorkerResult;
+
+static Card full_deck[NUM_CARDS];
+static int num_candidates = 0;
+static int next_unit = 0;
+static pthread_mutex_t unit_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Work is handed out as (first, second) card pairs so that the uneven
+ * subtrees under low card indices balance across threads. */
+static bool take_unit(int *first, int *second) {
+    bool found = false;
+
+    pthread_mutex_lock(&unit_lock);
+    while (next_unit < NUM_CARDS * NUM_CARDS) {
+        int a = next_unit / NUM_CARDS;
+        int b = next_unit % NUM_CARDS;
+        next_unit++;
+        if (b > a && b <= NUM_CARDS - 6) {
+            *first = a;
+            *second = b;
+            found = true;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&unit_lock);
+
+    return found;
+}
+
+static void check_hand(WorkerResult *result, Card *hand, Card *community) {
+    HandEvaluation reference = reference_evaluate_hand(hand, community, 5);
+    result->counts[reference.combination]++;
+
+    for (int i = 0; i < num_candidates; i++) {
+        HandEvaluation candidate = candidates[i].evaluate(hand, community, 5);
+        if (compare_evaluations(reference, candidate) != 0) {
+            if (result->mismatches == 0) {
+                result->first_mismatch_candidate = i;
+                memcpy(result->first_mismatch_cards, hand, HAND_SIZE * sizeof(Card));
+                memcpy(&result->first_mismatch_cards[HAND_SIZE], community, 5 * sizeof(Card));
+            }
+            result->mismatches++;
+        }
+    }
+}
+
+/* Counts are kept in a stack-local WorkerResult and published once at the end,
+ * so threads never write to neighbouring cache lines in the hot loop. */
+static void *verify_worker(void *arg) {
+    WorkerResult local;
+    memset(&local, 0, sizeof(local));
+    Card hand[HAND_SIZE];
+    Card community[5];
+    int a, b;
+
+    while (take_unit(&a, &b)) {
+        hand[0] = full_deck[a];
+        hand[1] = full_deck[b];
+        for (int c = b + 1; c < NUM_CARDS - 4; c++) {
+            community[0] = full_deck[c];
+            for (int d = c + 1; d < NUM_CARDS - 3; d++) {
+                community[1] = full_deck[d];
+                for (int e = d + 1; e < NUM_CARDS - 2; e++) {
+                    community[2] = full_deck[e];
+                    for (int f = e + 1; f < NUM_CARDS - 1; f++) {
+                        community[3] = full_deck[f];
+                        for (int g = f + 1; g < NUM_CARDS; g++) {
+                            community[4] = full_deck[g];
+                            check_hand(&local, hand, community);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    *(WorkerResult *)arg = local;
+    return NULL;
+}
+
+static int default_thread_count() {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    if (online < 1) return 1;
+    if (online > MAX_THREADS) return MAX_THREADS;
+    return (int)online;
+}
+
+int main(int argc, char **argv) {
+    int num_threads = default_thread_count();
+    if (argc > 1) {
+        num_threads = atoi(argv[1]);
+        if (num_threads < 1 || num_threads > MAX_THREADS) {
+            fprintf(stderr, "Usage: %s [threads 1-%d]\n", argv[0], MAX_THREADS);
+            return 2;
+        }
+    }
+
+    while (candidates[num_candidates].evaluate != NULL) num_candidates++;
+
+    for (int i = 0; i < NUM_CARDS; i++) full_deck[i] = index_to_card((CardIndex)i);
+
+    printf("Verifying all %lld seven-card hands on %d thread(s), %d candidate evaluator(s)\n",
+           NUM_SEVEN_CARD_HANDS, num_threads, num_candidates);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    pthread_t threads[MAX_THREADS];
+    WorkerResult results[MAX_THREADS];
+    memset(results, 0, sizeof(results));
+
+    for (int i = 0; i < num_threads; i++) {
+        if (pthread_create(&threads[i], NULL, verify_worker, &results[i]) != 0) {
+            fprintf(stderr, "Failed to start worker thread %d\n", i);
+            return 2;
+        }
+    }
+
+    long long counts[NUM_COMBINATIONS] = {0};
+    long long total = 0, mismatches = 0;
+    WorkerResult *first_failure = NULL;
+
+    for (int i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+        for (int combo = 0; combo < NUM_COMBINATIONS; combo++) {
+            counts[combo] += results[i].counts[combo];
+            total += results[i].counts[combo];
+        }
+        if (results[i].mismatches > 0 && first_failure == NULL) first_failure = &results[i];
+        mismatches += results[i].mismatches;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    bool ok = (total == NUM_SEVEN_CARD_HANDS);
+
+    printf("\n%-16s %12s %12s\n", "Combination", "Count", "Expected");
+    for (int combo = 0; combo < NUM_COMBINATIONS; combo++) {
+        bool match = (counts[combo] == reference_counts[combo]);
+        printf("%-16s %12lld %12lld%s\n", combination_name((Combination)combo),
+               counts[combo], reference_counts[combo], match ? "" : "  MISMATCH");
+        if (!match) ok = false;
+    }
+    printf("%-16s %12lld %12lld\n", "Total", total, NUM_SEVEN_CARD_HANDS);
+
+    if (mismatches > 0) {
+        ok = false;
+        printf("\n%lld evaluation mismatch(es); first from '%s' on: ", mismatches,
+               candidates[first_failure->first_mismatch_candidate].name);
+        for (int i = 0; i < 7; i++) {
+            print_card(first_failure->first_mismatch_cards[i]);
+            printf(" ");
+        }
+        printf("\n");
+    }
+
+    printf("\nElapsed: %.2f s (%.1f M hands/s)\n", elapsed, total / elapsed / 1e6);
+    printf("%s\n", ok ? "VERIFICATION PASSED" : "VERIFICATION FAILED");
+
+    return ok ? 0 : 1;
+}